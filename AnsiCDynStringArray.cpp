@@ -2,12 +2,17 @@
 //
 
 #include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <string>
 #include <assert.h>
 
 extern "C" {
     #include "include/ansi_c_mem_track.h"
     #include "include/ansi_c_dynstringarray.h"
+    #include "include/ansi_c_dynstringarray_profile.h"
 }
+#include "include/ansi_c_dynstringarray.hpp"
 
 bool test_dynstringarray()
 {
@@ -283,6 +288,370 @@ bool test_dynstringarray_insert() {
     return true;
 }
 
+bool test_dynstringarray_cpp_wrapper() {
+    {
+        ansi_c::dynstringarray arr;
+        assert(arr.empty());
+
+        // reserve and emplace_back from string_view slices
+        arr.reserve(100);
+        assert(arr.capacity() >= 100);
+        std::string_view source("hello world foo");
+        arr.emplace_back(source.substr(0, 5));
+        arr.emplace_back(source.substr(6, 5));
+        arr.emplace_back(source.substr(12));
+        assert(arr.size() == 3);
+        assert(arr[0] == "hello");
+        assert(arr[1] == "world");
+        assert(arr.at(2) == "foo");
+        assert(strcmp(ansi_c_dynstringarray_get(arr.get(), 1), "world") == 0);
+
+        // standard algorithms over the random-access iterators
+        assert(std::find(arr.begin(), arr.end(), "world") - arr.begin() == 1);
+        assert(std::count_if(arr.begin(), arr.end(), [](std::string_view s) { return s.size() == 5; }) == 2);
+        assert(arr.end() - arr.begin() == 3);
+        assert(*(arr.end() - 1) == "foo");
+
+        // move-only ownership
+        ansi_c::dynstringarray moved(std::move(arr));
+        assert(arr.size() == 0 && arr.get() == NULL);
+        assert(moved.size() == 3);
+        arr = std::move(moved);
+        assert(arr.size() == 3 && moved.get() == NULL);
+
+        // a moved-from object stays usable
+        assert(moved.empty() && moved.begin() == moved.end());
+        assert(moved[0].empty());
+        moved.emplace_back(std::string_view()); // null data() with zero length
+        assert(moved.size() == 1 && moved[0].empty() && moved[0].data() != NULL);
+        moved.clear();
+        moved.emplace_back("again");
+        assert(moved.size() == 1 && moved.at(0) == "again");
+        ansi_c::dynstringarray other(std::move(moved));
+        moved.reserve(4);
+        moved.resize(2, "x");
+        moved.compress();
+        moved.decompress();
+        assert(moved.size() == 2 && moved[1] == "x");
+        ansi_c::dynstringarray third(std::move(moved));
+        moved.resize(1);
+        assert(moved.size() == 1 && moved[0].empty());
+
+        // comparison algorithms on a compressed array read two blocks per comparison
+        ansi_c::dynstringarray compressed;
+        for (int i = 0; i < DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE; i++) {
+            compressed.emplace_back(i == 0 ? "zzzz" : "a");
+        }
+        for (int i = 0; i < DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE; i++) {
+            compressed.emplace_back(std::string(300, static_cast<char>('b' + i)));
+        }
+        compressed.compress();
+        assert(std::max_element(compressed.begin(), compressed.end()) - compressed.begin() == 0);
+        assert(!std::is_sorted(compressed.begin(), compressed.end()));
+        assert(std::is_sorted(compressed.begin() + DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE, compressed.end()));
+        assert(compressed.compressed());
+
+        ansi_c_mem_track_log_message(NULL, "Info", "After C++ wrapper emplace_back");
+        MemoryUsageInfo meminfo = ansi_c_mem_track_get_info();
+        ansi_c_mem_track_print_info(NULL, &meminfo);
+    }
+
+    // Log memory usage information
+    ansi_c_mem_track_log_message(NULL, "Info", "After C++ wrapper destroy");
+    MemoryUsageInfo meminfo = ansi_c_mem_track_get_info();
+    ansi_c_mem_track_print_info(NULL, &meminfo);
+
+    // Log unfreed memory blocks
+    size_t s = 0;
+    const MemoryBlock** mb = ansi_c_mem_track_get_unfreed_blocks_info(&s);
+    ansi_c_mem_track_log_unfreed_blocks_info(NULL, mb, s);
+
+    return true;
+}
+
+bool test_dynstringarray_compress(size_t blocksize) {
+    DynStringArray* arr = NULL;
+    int ret = ansi_c_dynstringarray_create(&arr);
+    assert(ret == 0);
+
+    for (size_t i = 0; i < blocksize; i++) {
+        char str[200];
+        sprintf_s(str, 200, "https://example.com/path/to/resource/%zd", i);
+        ret = ansi_c_dynstringarray_push(arr, str);
+        assert(ret == 0);
+    }
+    ret = ansi_c_dynstringarray_resize(arr, blocksize + 1); // NULL element must survive compression
+    assert(ret == 0);
+
+    ansi_c_mem_track_log_message(NULL, "Info", "Before dynstringarray compress");
+    MemoryUsageInfo meminfo = ansi_c_mem_track_get_info();
+    ansi_c_mem_track_print_info(NULL, &meminfo);
+
+    // compress
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    assert(arr->storage_mode == DYN_ARR_COMPRESSED);
+    assert(ansi_c_dynstringarray_size(arr) == blocksize + 1);
+
+    ansi_c_mem_track_log_message(NULL, "Info", "After dynstringarray compress");
+    meminfo = ansi_c_mem_track_get_info();
+    ansi_c_mem_track_print_info(NULL, &meminfo);
+
+    // random access decodes a single block
+    for (size_t i = blocksize; i-- > 0;) {
+        char str[200];
+        sprintf_s(str, 200, "https://example.com/path/to/resource/%zd", i);
+        size_t len = 0;
+        const char* value = ansi_c_dynstringarray_get_n(arr, i, &len);
+        assert(strcmp(value, str) == 0);
+        assert(len == strlen(str));
+    }
+    assert(ansi_c_dynstringarray_get(arr, blocksize) == NULL);
+
+    // modification decompresses the array
+    ret = ansi_c_dynstringarray_set(arr, 1, "changed");
+    assert(ret == 0);
+    assert(arr->storage_mode == DYN_ARR_PLAIN);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 1), "changed") == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 2), "https://example.com/path/to/resource/2") == 0);
+    assert(ansi_c_dynstringarray_get(arr, blocksize) == NULL);
+
+    // values read from the decode cache stay valid while the modification decompresses the array
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_set(arr, 0, ansi_c_dynstringarray_get(arr, 2));
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 0), "https://example.com/path/to/resource/2") == 0);
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_push(arr, ansi_c_dynstringarray_get(arr, 3));
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, blocksize + 1), "https://example.com/path/to/resource/3") == 0);
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_insert(arr, 4, ansi_c_dynstringarray_get(arr, 5) + 8);
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 4), "example.com/path/to/resource/5") == 0);
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_resize_fill(arr, blocksize + 4, ansi_c_dynstringarray_get(arr, 0));
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, blocksize + 3), "https://example.com/path/to/resource/2") == 0);
+
+    // copies stay valid after other blocks are decoded
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    char first[200], last[200], small[6];
+    assert(ansi_c_dynstringarray_get_copy(arr, 0, first, sizeof(first)) == 0);
+    assert(ansi_c_dynstringarray_get_copy(arr, blocksize + 2, last, sizeof(last)) == 0);
+    assert(strcmp(first, "https://example.com/path/to/resource/2") == 0);
+    assert(strcmp(last, "https://example.com/path/to/resource/3") == 0);
+    assert(ansi_c_dynstringarray_get_copy(arr, 1, small, sizeof(small)) == 0 && strcmp(small, "chang") == 0);
+    assert(ansi_c_dynstringarray_get_copy(arr, blocksize + 1, first, sizeof(first)) == -1); // NULL element
+    assert(ansi_c_dynstringarray_get_copy(arr, blocksize + 4, first, sizeof(first)) == -1); // out of range
+
+    // destroy while compressed
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    ansi_c_dynstringarray_destroy(&arr);
+    assert(arr == NULL);
+
+    // Log memory usage information
+    ansi_c_mem_track_log_message(NULL, "Info", "After dynstringarray destroy");
+    meminfo = ansi_c_mem_track_get_info();
+    ansi_c_mem_track_print_info(NULL, &meminfo);
+
+    // Log unfreed memory blocks
+    size_t s = 0;
+    const MemoryBlock** mb = ansi_c_mem_track_get_unfreed_blocks_info(&s);
+    ansi_c_mem_track_log_unfreed_blocks_info(NULL, mb, s);
+
+    return true;
+}
+
+bool test_dynstringarray_resize_fill(size_t blocksize) {
+    DynStringArray* arr = NULL;
+    int ret = ansi_c_dynstringarray_create(&arr);
+    assert(ret == 0);
+
+    ret = ansi_c_dynstringarray_push(arr, "first");
+    assert(ret == 0);
+
+    // lazy resize, set works on the new NULL elements
+    ret = ansi_c_dynstringarray_resize(arr, 3);
+    assert(ret == 0);
+    assert(ansi_c_dynstringarray_get(arr, 2) == NULL);
+    ret = ansi_c_dynstringarray_set(arr, 2, "third");
+    assert(ret == 0);
+    assert(ansi_c_dynstringarray_get(arr, 1) == NULL);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 2), "third") == 0);
+
+    // resize_fill shares one copy of the value
+    ret = ansi_c_dynstringarray_resize_fill(arr, 3 + blocksize, "placeholder");
+    assert(ret == 0);
+    assert(ansi_c_dynstringarray_size(arr) == 3 + blocksize);
+    assert(ansi_c_dynstringarray_get(arr, 3) == ansi_c_dynstringarray_get(arr, 2 + blocksize));
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 2 + blocksize), "placeholder") == 0);
+    assert(arr->materialized == 3);
+
+    ansi_c_mem_track_log_message(NULL, "Info", "After dynstringarray resize_fill");
+    MemoryUsageInfo meminfo = ansi_c_mem_track_get_info();
+    ansi_c_mem_track_print_info(NULL, &meminfo);
+
+    // copy-on-write
+    ret = ansi_c_dynstringarray_set(arr, 10, "written");
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 10), "written") == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 9), "placeholder") == 0);
+    assert(ansi_c_dynstringarray_get(arr, 11) == ansi_c_dynstringarray_get(arr, 9));
+
+    // removeAt and push keep the shared elements intact
+    char buffer[20];
+    ansi_c_dynstringarray_removeAt(arr, 4, buffer, sizeof(buffer));
+    assert(strcmp(buffer, "placeholder") == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 9), "written") == 0);
+    ret = ansi_c_dynstringarray_push(arr, "last");
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 2 + blocksize), "last") == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 1 + blocksize), "placeholder") == 0);
+
+    // a different fill value leaves the previous one shared
+    ret = ansi_c_dynstringarray_resize_fill(arr, 13, "other");
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_resize_fill(arr, 15, "other");
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 12), "placeholder") == 0);
+    assert(ansi_c_dynstringarray_get(arr, 12) == ansi_c_dynstringarray_get(arr, 10));
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 14), "other") == 0);
+    assert(ansi_c_dynstringarray_get(arr, 14) == ansi_c_dynstringarray_get(arr, 13));
+
+    // shrinking releases the shared value
+    ret = ansi_c_dynstringarray_resize(arr, 13);
+    assert(ret == 0);
+    assert(arr->fill == NULL);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 12), "placeholder") == 0);
+
+    // setting the last sharing element to the fill value itself
+    ret = ansi_c_dynstringarray_resize(arr, 0);
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_resize_fill(arr, 1, "placeholder");
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_set(arr, 0, ansi_c_dynstringarray_get(arr, 0));
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, 0), "placeholder") == 0);
+    assert(arr->fill == NULL);
+
+    // growing with another fill value allocates no string per shared element
+    size_t before = 0, after = 0;
+    ret = ansi_c_dynstringarray_resize_fill(arr, blocksize, "n/a");
+    assert(ret == 0);
+    ansi_c_mem_track_get_unfreed_blocks_info(&before);
+    ret = ansi_c_dynstringarray_resize(arr, blocksize + 1);
+    assert(ret == 0);
+    ansi_c_mem_track_get_unfreed_blocks_info(&after);
+    assert(after == before);
+    assert(ansi_c_dynstringarray_get(arr, 1) == ansi_c_dynstringarray_get(arr, blocksize - 1));
+    assert(strcmp(ansi_c_dynstringarray_get(arr, blocksize - 1), "n/a") == 0);
+    assert(ansi_c_dynstringarray_get(arr, blocksize) == NULL);
+    ret = ansi_c_dynstringarray_resize_fill(arr, blocksize + 2, "other");
+    assert(ret == 0);
+    ansi_c_mem_track_get_unfreed_blocks_info(&after);
+    assert(after == before + 1);
+    ret = ansi_c_dynstringarray_compress(arr);
+    assert(ret == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, blocksize - 1), "n/a") == 0);
+    assert(strcmp(ansi_c_dynstringarray_get(arr, blocksize + 1), "other") == 0);
+
+    ansi_c_dynstringarray_destroy(&arr);
+    assert(arr == NULL);
+
+    // Log memory usage information
+    ansi_c_mem_track_log_message(NULL, "Info", "After dynstringarray destroy");
+    meminfo = ansi_c_mem_track_get_info();
+    ansi_c_mem_track_print_info(NULL, &meminfo);
+
+    // Log unfreed memory blocks
+    size_t s = 0;
+    const MemoryBlock** mb = ansi_c_mem_track_get_unfreed_blocks_info(&s);
+    ansi_c_mem_track_log_unfreed_blocks_info(NULL, mb, s);
+
+    return true;
+}
+
+bool test_dynstringarray_profile(size_t blocksize) {
+    ansi_c_dynstringarray_profile_start();
+
+    DynStringArray* arr = NULL;
+    int ret = ansi_c_dynstringarray_create(&arr);
+    assert(ret == 0);
+    for (size_t i = 0; i < blocksize; i++) {
+        char str[200];
+        sprintf_s(str, 200, "hello%zd", i);
+        ret = ansi_c_dynstringarray_push(arr, str);
+        assert(ret == 0);
+    }
+    for (size_t i = 0; i < blocksize; i++) {
+        assert(ansi_c_dynstringarray_get(arr, i) != NULL);
+    }
+    ret = ansi_c_dynstringarray_set(arr, 0, "a longer value than before");
+    assert(ret == 0);
+    ret = ansi_c_dynstringarray_insert(arr, ansi_c_dynstringarray_size(arr), "inserted at the end");
+    assert(ret == 0);
+    ansi_c_dynstringarray_destroy(&arr);
+
+    ansi_c_dynstringarray_profile_stop();
+
+    DynStringArrayOpStats stats, insert_stats;
+    assert(ansi_c_dynstringarray_profile_get_op_stats(DYN_ARR_OP_PUSH, &stats));
+    assert(ansi_c_dynstringarray_profile_get_op_stats(DYN_ARR_OP_INSERT, &insert_stats));
+    size_t site_count = 0;
+    const DynStringArrayAllocStats* sites = ansi_c_dynstringarray_profile_get_alloc_stats(&site_count);
+#ifdef ANSI_C_DYNSTRINGARRAY_PROFILE
+    assert(stats.count == blocksize); // the insert at the end is not counted as a push
+    assert(insert_stats.count == 1);
+    assert(stats.p50_ns <= stats.p99_ns && stats.p99_ns <= stats.max_ns);
+    size_t reallocs = 0, push_reallocs = 0, push_string_max = 0;
+    for (size_t i = 0; i < site_count; i++) {
+        reallocs += sites[i].realloc_count;
+        size_t bucketed = 0;
+        for (size_t b = 0; b < 64; b++) {
+            bucketed += sites[i].size_histogram[b];
+        }
+        assert(bucketed == sites[i].count); // every request lands in one size bucket
+        if (strcmp(sites[i].call_site, "ansi_c_dynstringarray_push_n_body") == 0) {
+            if (strcmp(sites[i].type, "char**") == 0) {
+                push_reallocs = sites[i].realloc_count;
+            }
+            else if (strcmp(sites[i].type, "char*") == 0) {
+                push_string_max = sites[i].max_bytes;
+            }
+        }
+        assert(strcmp(sites[i].call_site, "ansi_c_dynstringarray_realloc_tables") != 0);
+    }
+    assert(reallocs > 0);
+    assert(push_reallocs > 0); // table growth is attributed to the growing operation
+    assert(push_string_max > 0 && push_string_max <= 32); // and kept apart from the string buffers it allocates
+#else
+    assert(stats.count == 0 && insert_stats.count == 0);
+    (void)sites;
+#endif
+
+    // Log the summary and write the Chrome trace
+    ansi_c_dynstringarray_profile_log_summary();
+    ret = ansi_c_dynstringarray_profile_write_trace("dynstringarray_trace.json");
+    assert(ret == 0);
+#ifdef ANSI_C_DYNSTRINGARRAY_PROFILE
+    // moved reallocations are always in the trace, most gets are sampled out
+    std::ifstream trace("dynstringarray_trace.json");
+    std::string json((std::istreambuf_iterator<char>(trace)), std::istreambuf_iterator<char>());
+    assert(json.find("\"name\":\"realloc\"") != std::string::npos);
+    assert(json.find("\"unsampledEvents\":0,") == std::string::npos);
+    assert(json.find("\"size_histogram\":{\"") != std::string::npos);
+#endif
+
+    return true;
+}
+
 int main()
 {
     // initialize
@@ -299,6 +668,14 @@ int main()
     test_dynstringarray_set();
     ansi_c_mem_track_log_message(NULL, "Info", "test test_dynstringarray_insert -----------");
     test_dynstringarray_insert();
+    ansi_c_mem_track_log_message(NULL, "Info", "test C++ wrapper ---------------------------");
+    test_dynstringarray_cpp_wrapper();
+    ansi_c_mem_track_log_message(NULL, "Info", "test ansi_c_dynstringarray_compress -------");
+    test_dynstringarray_compress(100000);
+    ansi_c_mem_track_log_message(NULL, "Info", "test ansi_c_dynstringarray_resize_fill ----");
+    test_dynstringarray_resize_fill(100000);
+    ansi_c_mem_track_log_message(NULL, "Info", "test dynstringarray profile ---------------");
+    test_dynstringarray_profile(10000);
     ansi_c_mem_track_log_message(NULL, "Info", "End of test -------------------------------");
     // Deinit
     ansi_c_mem_track_deinit();
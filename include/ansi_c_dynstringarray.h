@@ -38,6 +38,13 @@
  */
 #define DYNSTRINGARRAY_DEFAULT_CAPACITY 10
 
+/**
+ * @brief The number of strings front-coded together in one block of a compressed array.
+ * A random access decodes at most this many strings.
+ * @see ansi_c_dynstringarray_compress
+ */
+#define DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE 16
+
 /**
     * @brief The dyn_arr_alloc_mode enum specifies the allocation mode for a DynStringArray. This value is 
     * automatically set during initialization depending on the chosen initialization mode.
@@ -62,18 +69,43 @@ typedef enum {
     DYN_ARR_STATIC
 } dyn_arr_alloc_mode;
 
+/**
+    * @brief The dyn_arr_storage_mode enum specifies how the strings of a DynStringArray are stored.
+    *
+    * - DYN_ARR_PLAIN: Every string is a separate NUL-terminated allocation referenced from the data array.
+    * - DYN_ARR_COMPRESSED: The strings are front-coded in blocks of DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE.
+    *   Reading decodes a single block; any modification converts the array back to DYN_ARR_PLAIN.
+    *
+    * @see ansi_c_dynstringarray_compress, ansi_c_dynstringarray_decompress
+    */
+typedef enum {
+    DYN_ARR_PLAIN,
+    DYN_ARR_COMPRESSED
+} dyn_arr_storage_mode;
+
+/**
+ * @brief Front-coded block storage of a compressed DynStringArray. Its layout is private to the implementation.
+ */
+struct DynStringArrayBlocks;
+
 /**
  * @brief A dynamic string array structure
- * The structure contains a pointer to an array of strings, its current size, its current capacity,
- * and the current allocation mode. Additionally, it also stores the system-assigned object ID for
+ * The structure contains a pointer to an array of strings, the cached length of each string, its current
+ * size, its current capacity, and the current allocation and storage modes. Additionally, it also stores the system-assigned object ID for
  * the structure and the data array.
- * @see dyn_arr_alloc_mode
+ * @see dyn_arr_alloc_mode, dyn_arr_storage_mode
  */
 typedef struct {
     char** data; /*< Pointer to the array of strings*/
+    size_t* lengths; /*< Cached length of each string, parallel to data. The top bit marks an element sharing a fill string*/
     size_t size; /*< Current size of the array*/
     size_t capacity; /*< Current capacity of the array*/
     dyn_arr_alloc_mode alloc_mode; /*< Current allocation mode*/
+    dyn_arr_storage_mode storage_mode; /*< Current storage mode*/
+    struct DynStringArrayBlocks* blocks; /*< Compressed storage, used in DYN_ARR_COMPRESSED mode only*/
+    size_t materialized; /*< Number of leading elements written to data, the rest hold fill*/
+    char* fill; /*< Fill string of the last resize, held by the elements not written yet, or NULL*/
+    size_t fill_length; /*< Length of fill*/
     size_t system_object_id; /*< System - assigned object ID for the structure*/
     size_t data_object_id; /*<System - assigned object ID for the data array*/
 } DynStringArray;
@@ -117,6 +149,9 @@ void ansi_c_dynstringarray_clear(DynStringArray** arr);
  * new NULL elements are added to the end of the array.If the new size is equal to the current size, nothing
  * happens.
  *
+ * Growth is lazy: only the string table is reallocated, the new elements are not written until they are
+ * accessed by a modifying function. ansi_c_dynstringarray_set can be used on the new NULL elements.
+ *
  * If the reallocation of memory fails, the function returns - 1, otherwise it returns 0.
  *
  * @param arr The dynamic string array to resize.
@@ -125,6 +160,22 @@ void ansi_c_dynstringarray_clear(DynStringArray** arr);
  */
 int ansi_c_dynstringarray_resize(DynStringArray * arr, size_t new_size);
 
+/**
+ * @brief Resizes the specified dynamic string array and sets every new element to @p value.
+ *
+ * Works like ansi_c_dynstringarray_resize, but the new elements share a single copy of @p value until they are
+ * modified (copy-on-write), so growing by any number of elements costs one string and the string table.
+ * Every fill string carries its own reference count, so a different fill value, including NULL, does not copy
+ * the elements still sharing the previous one.
+ *
+ * @param arr The dynamic string array to resize.
+ * @param new_size The new size of the dynamic string array.
+ * @param value The value of the new elements. NULL gives the same result as ansi_c_dynstringarray_resize.
+ * @return int Returns 0 on success, -1 on failure.
+ * @see ansi_c_dynstringarray_resize, ansi_c_dynstringarray_set
+ */
+int ansi_c_dynstringarray_resize_fill(DynStringArray* arr, size_t new_size, const char* value);
+
 /**
  * @brief Adds a string value to the end of the dynamic string array.
  * If the dynamic string array is full, the function automatically resizes the array by increasing its capacity.
@@ -135,6 +186,28 @@ int ansi_c_dynstringarray_resize(DynStringArray * arr, size_t new_size);
  */
 int ansi_c_dynstringarray_push(DynStringArray* arr, const char* value);
 
+/**
+ * @brief Adds the first @p len characters of @p value to the end of the dynamic string array.
+ * The source does not need to be NUL-terminated, so a slice of a larger buffer can be appended without
+ * making an intermediate copy. The stored string is always NUL-terminated.
+ * @param arr A pointer to the dynamic string array.
+ * @param value A pointer to the characters to be added to the array.
+ * @param len The number of characters to copy from @p value.
+ * @return 0 on success, -1 on failure.
+ * @see ansi_c_dynstringarray_push
+ */
+int ansi_c_dynstringarray_push_n(DynStringArray* arr, const char* value, size_t len);
+
+/**
+ * @brief Ensures that the dynamic string array can hold at least @p capacity elements without reallocation.
+ * If the current capacity is already large enough, nothing happens. The size of the array is not changed.
+ * @param arr A pointer to the dynamic string array.
+ * @param capacity The minimum capacity requested.
+ * @return 0 on success, -1 on failure.
+ * @see ansi_c_dynstringarray_resize
+ */
+int ansi_c_dynstringarray_reserve(DynStringArray* arr, size_t capacity);
+
 /**
  * @brief Removes the string at the specified index from the dynamic string array.
  * @param arr A pointer to the dynamic string array.
@@ -166,13 +239,44 @@ void ansi_c_dynstringarray_init(DynStringArray* arr, size_t count, ...);
 
 /**
  * @brief Returns the string value at the given index in the dynamic string array.
+ *
+ * In DYN_ARR_COMPRESSED mode the returned pointer points into the decode cache of the array, which holds the
+ * two most recently read blocks. It stays valid while one other block is read, so two elements can be compared,
+ * but not after elements of two other blocks are read. Reading decodes into the cache even though @p arr is
+ * const, so concurrent readers of a compressed array must be serialized. Use ansi_c_dynstringarray_get_copy to
+ * keep an element longer.
+ *
  * @param arr A pointer to the dynamic string array.
  * @param index The index of the string value to retrieve.
  * @return A pointer to the string value at the given index.
- * @see ansi_c_dynstringarray_size
+ * @see ansi_c_dynstringarray_size, ansi_c_dynstringarray_get_copy
  */
 const char* ansi_c_dynstringarray_get(const DynStringArray* arr, size_t index);
 
+/**
+ * @brief Returns the string value and its cached length at the given index in the dynamic string array.
+ * The lifetime and thread-safety rules of ansi_c_dynstringarray_get apply to the returned pointer.
+ * @param arr A pointer to the dynamic string array.
+ * @param index The index of the string value to retrieve.
+ * @param len A pointer that receives the length of the string. Can be NULL.
+ * @return A pointer to the string value at the given index, or NULL if the index is out of range.
+ * @see ansi_c_dynstringarray_get
+ */
+const char* ansi_c_dynstringarray_get_n(const DynStringArray* arr, size_t index, size_t* len);
+
+/**
+ * @brief Copies the string value at the given index into a caller-provided buffer.
+ * The copy stays valid whatever is read or modified later, which makes it the safe way to keep elements of a
+ * compressed array. Like ansi_c_dynstringarray_get it may decode into the cache of a compressed array.
+ * @param arr A pointer to the dynamic string array.
+ * @param index The index of the string value to copy.
+ * @param buffer A pointer to the buffer that receives the string.
+ * @param buf_size The size of the buffer in bytes. If the buffer is not large enough to store the string, it will be truncated to fit.
+ * @return 0 on success, -1 if the index is out of range, the element is NULL or the buffer is empty.
+ * @see ansi_c_dynstringarray_get
+ */
+int ansi_c_dynstringarray_get_copy(const DynStringArray* arr, size_t index, char* buffer, size_t buf_size);
+
 /**
  * @brief Sets the string value at the given index in the dynamic string array.
  *
@@ -203,5 +307,33 @@ int ansi_c_dynstringarray_set(DynStringArray* arr, size_t index, const char* val
  */
 int ansi_c_dynstringarray_insert(DynStringArray* arr, size_t index, const char* value);
 
+/**
+ * @brief Converts the dynamic string array to the read-mostly DYN_ARR_COMPRESSED storage mode.
+ *
+ * The strings are front-coded in blocks of DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE: each string stores only the
+ * suffix that differs from the previous string of its block, and a per-block offset index keeps random access.
+ * The individual string allocations and the data array are released.
+ *
+ * In compressed mode ansi_c_dynstringarray_get and ansi_c_dynstringarray_get_n decode only the block of the
+ * requested element into a cache of DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE-element blocks owned by the array. The
+ * cache keeps the two most recently read blocks and is sized once by this function. The returned pointer is
+ * valid until elements of two other blocks are read or the array is modified. Any modifying function first converts the array back to
+ * DYN_ARR_PLAIN mode; a value just read from the array can still be passed to it.
+ *
+ * @param arr A pointer to the dynamic string array.
+ * @return 0 on success, -1 on failure. On failure the array is left unchanged.
+ * @see dyn_arr_storage_mode, ansi_c_dynstringarray_decompress
+ */
+int ansi_c_dynstringarray_compress(DynStringArray* arr);
+
+/**
+ * @brief Converts a compressed dynamic string array back to the DYN_ARR_PLAIN storage mode.
+ * If the array is not compressed, nothing happens.
+ * @param arr A pointer to the dynamic string array.
+ * @return 0 on success, -1 on failure. On failure the array stays compressed.
+ * @see ansi_c_dynstringarray_compress
+ */
+int ansi_c_dynstringarray_decompress(DynStringArray* arr);
+
 
 #endif /* ANSI_C_DYNSTRINGARRAY_H */
@@ -0,0 +1,293 @@
+/**
+    *
+    *   @file ansi_c_dynstringarray.hpp
+    *   @brief Header-only C++ wrapper for the dynamic array of C strings.
+    *   This header provides an owning, move-only C++17 class over DynStringArray. Elements are exposed as
+    *   std::string_view using the cached string lengths of the array, so reading and iterating never calls
+    *   strlen() and never allocates.
+    *
+    *   Dependencies: https://github.com/vajayattila/AnsiCMemTrack.git
+    *
+    *	@author Attila Vajay
+    *	@email vajay.attila@gmail.com
+    *	@git https://github.com/vajayattila/AnsiCDynStringArray.git
+    *   @date 2026.10.18.
+    *   @version 1.0
+    *   @license MIT License
+    *   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+    *   (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+    *   publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+    *   subject to the following conditions:
+    *   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+    *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    *   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+    *   ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    *   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+    *   For more information, see the file LICENSE.
+    */
+#ifndef ANSI_C_DYNSTRINGARRAY_HPP
+#define ANSI_C_DYNSTRINGARRAY_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+extern "C" {
+    #include "ansi_c_dynstringarray.h"
+}
+
+namespace ansi_c {
+
+/**
+ * @brief Owning, move-only C++ wrapper of a DynStringArray.
+ *
+ * The wrapped array is created in DYN_ARR_DYNAMIC mode and destroyed by the destructor. Copying is
+ * disabled so that an array is never deep-copied by accident; ownership is transferred with std::move.
+ * A moved-from object is empty and stays usable: the next modifying call creates a new array.
+ * The AnsiCMemTrack library must be initialized before an instance is constructed.
+ *
+ * @code{.cpp}
+ * ansi_c::dynstringarray arr;
+ * arr.reserve(2);
+ * arr.emplace_back("hello");
+ * arr.emplace_back(std::string_view("world!").substr(0, 5));
+ * auto it = std::find(arr.begin(), arr.end(), "world"); // no allocation
+ * @endcode
+ * @see DynStringArray, ansi_c_dynstringarray_create, ansi_c_dynstringarray_destroy
+ */
+class dynstringarray {
+public:
+    using value_type = std::string_view;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * @brief Proxy iterator yielding the elements as std::string_view.
+     * Dereferencing returns the view by value and reads the cached length of the element, so it does not
+     * scan the string. It supports the random-access operations, but because reference is not a real
+     * reference it reports std::input_iterator_tag to C++17 algorithms; C++20 ranges see the
+     * random_access_iterator_tag iterator_concept.
+     * On a compressed array a view stays valid while one other block is read, so comparison algorithms such
+     * as std::max_element and std::is_sorted work; a view kept across reads of two other blocks does not.
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+#if __cplusplus >= 202002L
+        using iterator_concept = std::random_access_iterator_tag;
+#endif
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        const_iterator() noexcept : arr_(nullptr), index_(0) {}
+        const_iterator(const DynStringArray* arr, size_type index) noexcept : arr_(arr), index_(index) {}
+
+        reference operator*() const noexcept { return at(index_); }
+        reference operator[](difference_type n) const noexcept { return at(index_ + n); }
+
+        const_iterator& operator++() noexcept { ++index_; return *this; }
+        const_iterator operator++(int) noexcept { const_iterator tmp(*this); ++index_; return tmp; }
+        const_iterator& operator--() noexcept { --index_; return *this; }
+        const_iterator operator--(int) noexcept { const_iterator tmp(*this); --index_; return tmp; }
+        const_iterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+        const_iterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+
+        friend const_iterator operator+(const_iterator it, difference_type n) noexcept { return it += n; }
+        friend const_iterator operator+(difference_type n, const_iterator it) noexcept { return it += n; }
+        friend const_iterator operator-(const_iterator it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(const const_iterator& a, const const_iterator& b) noexcept {
+            return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+        }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept { return a.index_ == b.index_; }
+        friend bool operator!=(const const_iterator& a, const const_iterator& b) noexcept { return a.index_ != b.index_; }
+        friend bool operator<(const const_iterator& a, const const_iterator& b) noexcept { return a.index_ < b.index_; }
+        friend bool operator>(const const_iterator& a, const const_iterator& b) noexcept { return a.index_ > b.index_; }
+        friend bool operator<=(const const_iterator& a, const const_iterator& b) noexcept { return a.index_ <= b.index_; }
+        friend bool operator>=(const const_iterator& a, const const_iterator& b) noexcept { return a.index_ >= b.index_; }
+
+    private:
+        std::string_view at(size_type index) const noexcept {
+            if (arr_ == nullptr) {
+                return std::string_view();
+            }
+            size_t len = 0;
+            const char* str = ansi_c_dynstringarray_get_n(arr_, index, &len);
+            return std::string_view(str, len);
+        }
+
+        const DynStringArray* arr_;
+        size_type index_;
+    };
+
+    using iterator = const_iterator;
+
+    /**
+     * @brief Creates an empty array.
+     * @throw std::bad_alloc if the array could not be created.
+     */
+    dynstringarray() : arr_(nullptr) {
+        handle();
+    }
+
+    /**
+     * @brief Takes ownership of an array created with ansi_c_dynstringarray_create in DYN_ARR_DYNAMIC mode.
+     * @param arr The array to adopt. Can be NULL, which gives an empty, moved-from state.
+     */
+    explicit dynstringarray(DynStringArray* arr) noexcept : arr_(arr) {}
+
+    ~dynstringarray() {
+        if (arr_) {
+            ansi_c_dynstringarray_destroy(&arr_);
+        }
+    }
+
+    dynstringarray(const dynstringarray&) = delete;
+    dynstringarray& operator=(const dynstringarray&) = delete;
+
+    dynstringarray(dynstringarray&& other) noexcept : arr_(other.arr_) {
+        other.arr_ = nullptr;
+    }
+
+    dynstringarray& operator=(dynstringarray&& other) noexcept {
+        if (this != &other) {
+            if (arr_) {
+                ansi_c_dynstringarray_destroy(&arr_);
+            }
+            arr_ = std::exchange(other.arr_, nullptr);
+        }
+        return *this;
+    }
+
+    size_type size() const noexcept { return arr_ ? arr_->size : 0; }
+    size_type capacity() const noexcept { return arr_ ? arr_->capacity : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * @brief Ensures room for at least @p capacity elements without reallocating the string table.
+     * @throw std::bad_alloc on allocation failure.
+     */
+    void reserve(size_type capacity) {
+        if (ansi_c_dynstringarray_reserve(handle(), capacity) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Appends a copy of @p value. The characters are copied once, directly into the new element.
+     * @throw std::bad_alloc on allocation failure.
+     */
+    void emplace_back(std::string_view value) {
+        if (ansi_c_dynstringarray_push_n(handle(), value.data(), value.size()) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+
+    void push_back(std::string_view value) { emplace_back(value); }
+
+    /**
+     * @brief Resizes the array. New elements are NULL and read as empty views; growth does not write them.
+     * @throw std::bad_alloc on allocation failure.
+     * @see ansi_c_dynstringarray_resize
+     */
+    void resize(size_type new_size) {
+        if (ansi_c_dynstringarray_resize(handle(), new_size) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Resizes the array. New elements share one copy of @p value until they are modified.
+     * @throw std::bad_alloc on allocation failure.
+     * @see ansi_c_dynstringarray_resize_fill
+     */
+    void resize(size_type new_size, const char* value) {
+        if (ansi_c_dynstringarray_resize_fill(handle(), new_size, value) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Switches to the read-mostly compressed storage mode.
+     * @throw std::bad_alloc on allocation failure.
+     * @see ansi_c_dynstringarray_compress
+     */
+    void compress() {
+        if (ansi_c_dynstringarray_compress(handle()) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Switches back to the plain storage mode. Modifying a compressed array does this implicitly.
+     * @throw std::bad_alloc on allocation failure.
+     * @see ansi_c_dynstringarray_decompress
+     */
+    void decompress() {
+        if (ansi_c_dynstringarray_decompress(handle()) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+
+    bool compressed() const noexcept { return arr_ && arr_->storage_mode == DYN_ARR_COMPRESSED; }
+
+    /**
+     * @brief Removes all elements and resets the capacity to DYNSTRINGARRAY_DEFAULT_CAPACITY.
+     */
+    void clear() noexcept {
+        if (arr_) {
+            ansi_c_dynstringarray_clear(&arr_);
+        }
+    }
+
+    std::string_view operator[](size_type index) const noexcept { return begin()[static_cast<difference_type>(index)]; }
+
+    /**
+     * @brief Returns the element at @p index.
+     * @throw std::out_of_range if @p index is not less than size().
+     */
+    std::string_view at(size_type index) const {
+        if (index >= size()) {
+            throw std::out_of_range("ansi_c::dynstringarray::at");
+        }
+        return (*this)[index];
+    }
+
+    const_iterator begin() const noexcept { return const_iterator(arr_, 0); }
+    const_iterator end() const noexcept { return const_iterator(arr_, size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    /**
+     * @brief Returns the underlying array for use with the C API. Ownership is kept by the wrapper.
+     */
+    DynStringArray* get() const noexcept { return arr_; }
+
+    /**
+     * @brief Releases ownership of the underlying array. The caller must destroy it.
+     */
+    DynStringArray* release() noexcept { return std::exchange(arr_, nullptr); }
+
+private:
+    /**
+     * @brief Returns the underlying array, creating an empty one first if this object was moved from.
+     * @throw std::bad_alloc if the array could not be created.
+     */
+    DynStringArray* handle() {
+        if (arr_ == nullptr && (ansi_c_dynstringarray_create(&arr_) != 0 || arr_ == nullptr)) {
+            throw std::bad_alloc();
+        }
+        return arr_;
+    }
+
+    DynStringArray* arr_;
+};
+
+} // namespace ansi_c
+
+#endif /* ANSI_C_DYNSTRINGARRAY_HPP */
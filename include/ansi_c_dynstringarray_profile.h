@@ -0,0 +1,188 @@
+/**
+    *
+    *   @file ansi_c_dynstringarray_profile.h
+    *   @brief Latency and allocation profiler of the dynamic array of C strings.
+    *   When the library is built with ANSI_C_DYNSTRINGARRAY_PROFILE defined, every public operation records its
+    *   latency and every allocation records its call site and size. Reallocations are tagged with the number of
+    *   bytes moved. The results can be written as a Chrome trace JSON file (chrome://tracing, Perfetto) and
+    *   logged through the AnsiCMemTrack log. The profiler uses static buffers only, so it does not change the
+    *   memory usage reported by AnsiCMemTrack. It is not thread-safe.
+    *
+    *   Dependencies: https://github.com/vajayattila/AnsiCMemTrack.git
+    *
+    *	@author Attila Vajay
+    *	@email vajay.attila@gmail.com
+    *	@git https://github.com/vajayattila/AnsiCDynStringArray.git
+    *   @date 2026.10.18.
+    *   @version 1.0
+    *   @license MIT License
+    *   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+    *   (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+    *   publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+    *   subject to the following conditions:
+    *   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+    *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    *   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+    *   ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    *   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+    *   For more information, see the file LICENSE.
+    */
+#ifndef ANSI_C_DYNSTRINGARRAY_PROFILE_H
+#define ANSI_C_DYNSTRINGARRAY_PROFILE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief The maximum number of kept trace events: reallocations that moved their block and operations slower
+ * than DYNSTRINGARRAY_PROFILE_SLOW_OP_NS. Later ones are counted as dropped.
+ */
+#ifndef DYNSTRINGARRAY_PROFILE_MAX_EVENTS
+#define DYNSTRINGARRAY_PROFILE_MAX_EVENTS 65536
+#endif
+
+/**
+ * @brief Operations that take at least this many nanoseconds are always kept in the trace.
+ */
+#ifndef DYNSTRINGARRAY_PROFILE_SLOW_OP_NS
+#define DYNSTRINGARRAY_PROFILE_SLOW_OP_NS 10000
+#endif
+
+/**
+ * @brief One in this many of the other events is sampled into the trace.
+ */
+#ifndef DYNSTRINGARRAY_PROFILE_SAMPLE_RATE
+#define DYNSTRINGARRAY_PROFILE_SAMPLE_RATE 64
+#endif
+
+/**
+ * @brief The number of sampled events kept in a ring buffer, which keeps the latest ones.
+ */
+#ifndef DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS
+#define DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS 16384
+#endif
+
+/**
+ * @brief The maximum number of distinct allocation call sites tracked.
+ */
+#ifndef DYNSTRINGARRAY_PROFILE_MAX_CALL_SITES
+#define DYNSTRINGARRAY_PROFILE_MAX_CALL_SITES 32
+#endif
+
+/**
+ * @brief The operations whose latency is recorded.
+ */
+typedef enum {
+    DYN_ARR_OP_PUSH,
+    DYN_ARR_OP_INSERT,
+    DYN_ARR_OP_SET,
+    DYN_ARR_OP_GET,
+    DYN_ARR_OP_REMOVE_AT,
+    DYN_ARR_OP_RESIZE,
+    DYN_ARR_OP_RESERVE,
+    DYN_ARR_OP_COMPRESS,
+    DYN_ARR_OP_DECOMPRESS,
+    DYN_ARR_OP_COUNT
+} dyn_arr_profile_op;
+
+/**
+ * @brief Latency statistics of one operation.
+ * Percentiles come from a histogram that splits every power of two into 16 linear sub-buckets, and report the
+ * upper bound of their bucket, capped at max_ns. They are within 1/16 (6.25%) of the exact value.
+ */
+typedef struct {
+    size_t count; /*< Number of calls*/
+    uint64_t total_ns; /*< Sum of the latencies*/
+    uint64_t p50_ns; /*< Median latency*/
+    uint64_t p99_ns; /*< 99th percentile latency*/
+    uint64_t max_ns; /*< Maximum latency*/
+} DynStringArrayOpStats;
+
+/**
+ * @brief Allocation statistics of one call site, identified by the name of the allocating function and the type
+ * of the allocated block.
+ */
+typedef struct {
+    const char* call_site; /*< Name of the allocating function*/
+    const char* type; /*< Type of the allocated block, such as "char*" for strings or "char**" for the string table*/
+    size_t count; /*< Number of allocations and reallocations*/
+    size_t total_bytes; /*< Sum of the requested sizes*/
+    size_t max_bytes; /*< Largest requested size*/
+    size_t size_histogram[64]; /*< Number of requests per log2 size bucket, bucket b holds sizes from 2^b below 2^(b+1), bucket 0 holds 0 and 1*/
+    size_t realloc_count; /*< Number of reallocations*/
+    size_t bytes_moved; /*< Bytes copied by reallocations that moved the block*/
+} DynStringArrayAllocStats;
+
+/**
+ * @brief Clears all recorded data and starts recording.
+ * @see ansi_c_dynstringarray_profile_stop
+ */
+void ansi_c_dynstringarray_profile_start(void);
+
+/**
+ * @brief Stops recording. The recorded data is kept until the next ansi_c_dynstringarray_profile_start.
+ */
+void ansi_c_dynstringarray_profile_stop(void);
+
+/**
+ * @brief Returns the latency statistics of an operation.
+ * @param op The operation.
+ * @param[out] stats Receives the statistics.
+ * @return true if @p op is valid, false otherwise.
+ */
+bool ansi_c_dynstringarray_profile_get_op_stats(dyn_arr_profile_op op, DynStringArrayOpStats* stats);
+
+/**
+ * @brief Returns the allocation statistics of every call site seen.
+ * @param[out] count Receives the number of call sites.
+ * @return A pointer to the per-call-site statistics, valid until the next ansi_c_dynstringarray_profile_start.
+ */
+const DynStringArrayAllocStats* ansi_c_dynstringarray_profile_get_alloc_stats(size_t* count);
+
+/**
+ * @brief Writes the recorded operations and reallocations as a Chrome trace JSON file.
+ * Operations are complete ("X") events, reallocations are instant ("i") events carrying the call site,
+ * the old and new sizes and the bytes moved. Reallocations that moved their block and slow operations are
+ * always written, the other events are sampled. The statistics, which cover every event, are added under
+ * the "dynStringArrayProfile" key.
+ * @param filename The path of the file to write.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+int ansi_c_dynstringarray_profile_write_trace(const char* filename);
+
+/**
+ * @brief Writes the latency percentiles and the per-call-site allocation statistics, including the size
+ * histogram, to the AnsiCMemTrack log.
+ */
+void ansi_c_dynstringarray_profile_log_summary(void);
+
+/**
+ * @brief Hooks called by the library. Not intended to be called directly.
+ */
+uint64_t ansi_c_dynstringarray_profile_now(void);
+void ansi_c_dynstringarray_profile_record_op(dyn_arr_profile_op op, uint64_t start_ns, size_t size);
+void ansi_c_dynstringarray_profile_record_alloc(const char* call_site, const char* type, const void* old_ptr, const void* new_ptr, size_t old_size, size_t new_size);
+void* ansi_c_dynstringarray_profile_malloc(size_t size, const char* file, const char* function, const char* type, size_t object_id);
+
+/**
+ * @brief Allocation and realloc hooks of the library. DYNSTRINGARRAY_MALLOC allocates through AnsiCMemTrack and,
+ * when profiling, records the calling function and @p type as the call site. DYNSTRINGARRAY_PROFILE_REALLOC
+ * records a reallocation of a @p type block already done by the caller under @p call_site.
+ */
+#ifdef ANSI_C_DYNSTRINGARRAY_PROFILE
+#define DYNSTRINGARRAY_PROFILE_BEGIN(start) uint64_t start = ansi_c_dynstringarray_profile_now()
+#define DYNSTRINGARRAY_PROFILE_END(op, start, size) ansi_c_dynstringarray_profile_record_op((op), (start), (size))
+#define DYNSTRINGARRAY_PROFILE_REALLOC(call_site, type, old_ptr, new_ptr, old_size, new_size) \
+    ansi_c_dynstringarray_profile_record_alloc((call_site), (type), (old_ptr), (new_ptr), (old_size), (new_size))
+#define DYNSTRINGARRAY_MALLOC(size, type, object_id) \
+    ansi_c_dynstringarray_profile_malloc((size), __FILE__, __FUNCTION__, (type), (object_id))
+#else
+#define DYNSTRINGARRAY_PROFILE_BEGIN(start)
+#define DYNSTRINGARRAY_PROFILE_END(op, start, size) ((void)0)
+#define DYNSTRINGARRAY_PROFILE_REALLOC(call_site, type, old_ptr, new_ptr, old_size, new_size) ((void)(call_site))
+#define DYNSTRINGARRAY_MALLOC(size, type, object_id) \
+    ansi_c_mem_track_malloc((size), __FILE__, __FUNCTION__, (type), (object_id))
+#endif
+
+#endif /* ANSI_C_DYNSTRINGARRAY_PROFILE_H */
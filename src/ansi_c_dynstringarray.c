@@ -1,23 +1,322 @@
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 
 #include "../include/ansi_c_dynstringarray.h"
 #include "../include/ansi_c_mem_track.h"
 #include "../include/ansi_c_macro_utils.h"
+#include "../include/ansi_c_dynstringarray_profile.h"
+
+/**
+ * Marks an empty entry of the decode cache of a compressed array.
+ */
+#define DYNSTRINGARRAY_NO_BLOCK ((size_t)-1)
+
+/**
+ * Marks the cached length of an element that shares a fill string instead of owning its string.
+ */
+#define DYNSTRINGARRAY_SHARED_LENGTH (~((size_t)-1 >> 1))
+
+/**
+ * A string set by ansi_c_dynstringarray_resize_fill. It is shared by the elements it was assigned to,
+ * counting the lazily grown ones, and freed when the last of them is modified or removed.
+ */
+typedef struct {
+    size_t refs; /*< Number of elements sharing the string*/
+    char value[]; /*< The string itself*/
+} DynStringArrayFill;
+
+/**
+ * Number of decoded blocks kept by a compressed array. With two, a value read from one block stays valid
+ * while an element of another block is read, so pairwise comparisons of elements work.
+ */
+#define DYNSTRINGARRAY_CACHED_BLOCKS 2
+
+/**
+ * A decoded block of a compressed array.
+ */
+typedef struct {
+    size_t block; /*< Index of the decoded block, or DYNSTRINGARRAY_NO_BLOCK*/
+    size_t last_read; /*< Value of the read counter at the last read, for least recently used eviction*/
+    char* buffer; /*< Decoded strings stored back to back*/
+    const char* strings[DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE]; /*< Decoded strings, NULL for NULL elements*/
+    size_t lengths[DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE]; /*< Lengths of the decoded strings*/
+} DynStringArrayDecodedBlock;
+
+/**
+ * Front-coded storage of a compressed array. Every entry of a block is encoded as two LEB128 varints,
+ * the length of the prefix shared with the previous entry of the block and (suffix length << 1 | is NULL),
+ * followed by the suffix bytes. The first entry of each block is stored in full.
+ */
+struct DynStringArrayBlocks {
+    size_t block_count; /*< Number of encoded blocks*/
+    size_t* block_offsets; /*< Start of each block in bytes, block_count + 1 entries*/
+    unsigned char* bytes; /*< Encoded blocks*/
+    char* cache; /*< Buffers of the decoded blocks, DYNSTRINGARRAY_CACHED_BLOCKS * block_capacity bytes*/
+    size_t block_capacity; /*< Size of the largest decoded block, so the cache is never reallocated*/
+    size_t reads; /*< Read counter*/
+    DynStringArrayDecodedBlock decoded[DYNSTRINGARRAY_CACHED_BLOCKS]; /*< The decoded blocks*/
+};
 
 bool ansi_c_dynstringarray_initdata(DynStringArray** arr, dyn_arr_alloc_mode mode) {
     size_t capacity = DYNSTRINGARRAY_DEFAULT_CAPACITY;  // new min capacity
-    char** data = (char**)ansi_c_mem_track_malloc(capacity * sizeof(char*), __FILE__, __FUNCTION__, "char**", (*arr)->data_object_id);
-    if (!data) {
+    char** data = (char**)DYNSTRINGARRAY_MALLOC(capacity * sizeof(char*), "char**", (*arr)->data_object_id);
+    size_t* lengths = (size_t*)DYNSTRINGARRAY_MALLOC(capacity * sizeof(size_t), "size_t*", (*arr)->data_object_id);
+    if (!data || !lengths) {
+        if (data) {
+            ansi_c_mem_track_free(data);
+        }
+        if (lengths) {
+            ansi_c_mem_track_free(lengths);
+        }
         (*arr)->data = NULL;
+        (*arr)->lengths = NULL;
         (*arr)->capacity = 0;
         return false;
     }
     (*arr)->data = data;
     (*arr)->data[0] = NULL;
+    (*arr)->lengths = lengths;
     (*arr)->capacity = capacity;
     (*arr)->size = 0;
     (*arr)->alloc_mode = mode;
+    (*arr)->storage_mode = DYN_ARR_PLAIN;
+    (*arr)->blocks = NULL;
+    (*arr)->materialized = 0;
+    (*arr)->fill = NULL;
+    (*arr)->fill_length = 0;
+    return true;
+}
+
+/**
+ * Grows the string table and the length table. call_site is the name of the calling function, which the
+ * profiler records as the owner of the reallocation.
+ */
+static bool ansi_c_dynstringarray_realloc_tables(DynStringArray* arr, size_t new_capacity, const char* call_site) {
+    // The string table and the length table always share the same capacity
+    char** new_data = ansi_c_mem_track_realloc(arr->data, new_capacity * sizeof(char*), arr->data_object_id);
+    DYNSTRINGARRAY_PROFILE_REALLOC(call_site, "char**", arr->data, new_data, arr->capacity * sizeof(char*), new_capacity * sizeof(char*));
+    if (new_data == NULL) {
+        return false;
+    }
+    arr->data = new_data;
+    size_t* new_lengths = ansi_c_mem_track_realloc(arr->lengths, new_capacity * sizeof(size_t), arr->data_object_id);
+    DYNSTRINGARRAY_PROFILE_REALLOC(call_site, "size_t*", arr->lengths, new_lengths, arr->capacity * sizeof(size_t), new_capacity * sizeof(size_t));
+    if (new_lengths == NULL) {
+        return false;
+    }
+    arr->lengths = new_lengths;
+    arr->capacity = new_capacity;
+    return true;
+}
+
+static size_t ansi_c_dynstringarray_varint_size(size_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static unsigned char* ansi_c_dynstringarray_varint_write(unsigned char* out, size_t value) {
+    while (value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+static const unsigned char* ansi_c_dynstringarray_varint_read(const unsigned char* in, size_t* value) {
+    size_t result = 0;
+    unsigned int shift = 0;
+    while (*in & 0x80) {
+        result |= (size_t)(*in++ & 0x7f) << shift;
+        shift += 7;
+    }
+    result |= (size_t)(*in++) << shift;
+    *value = result;
+    return in;
+}
+
+/**
+ * Encodes the element at index into out and returns the number of bytes used. If out is NULL,
+ * only the encoded size is computed.
+ */
+static size_t ansi_c_dynstringarray_encode_entry(const DynStringArray* arr, size_t index, unsigned char* out) {
+    const char* value = arr->data[index];
+    size_t len = arr->lengths[index] & ~DYNSTRINGARRAY_SHARED_LENGTH, shared = 0;
+    if (index % DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE != 0 && value != NULL && arr->data[index - 1] != NULL) {
+        const char* prev = arr->data[index - 1];
+        size_t prev_len = arr->lengths[index - 1] & ~DYNSTRINGARRAY_SHARED_LENGTH;
+        size_t max_shared = prev_len < len ? prev_len : len;
+        while (shared < max_shared && prev[shared] == value[shared]) {
+            shared++;
+        }
+    }
+    size_t suffix = len - shared, header = (suffix << 1) | (value == NULL ? 1 : 0);
+    if (out == NULL) {
+        return ansi_c_dynstringarray_varint_size(shared) + ansi_c_dynstringarray_varint_size(header) + suffix;
+    }
+    unsigned char* p = ansi_c_dynstringarray_varint_write(out, shared);
+    p = ansi_c_dynstringarray_varint_write(p, header);
+    if (suffix > 0) {
+        memcpy(p, value + shared, suffix);
+    }
+    return (size_t)(p - out) + suffix;
+}
+
+/**
+ * Returns the decoded block, decoding it into the least recently read cache entry if needed. The cache is
+ * written even though arr is const, so reads of a compressed array must not run concurrently.
+ */
+static const DynStringArrayDecodedBlock* ansi_c_dynstringarray_decode_block(const DynStringArray* arr, size_t block) {
+    struct DynStringArrayBlocks* blocks = arr->blocks;
+    DynStringArrayDecodedBlock* entry = &blocks->decoded[0];
+    for (size_t e = 0; e < DYNSTRINGARRAY_CACHED_BLOCKS; e++) {
+        if (blocks->decoded[e].block == block) {
+            entry = &blocks->decoded[e];
+            entry->last_read = ++blocks->reads;
+            return entry;
+        }
+        if (blocks->decoded[e].last_read < entry->last_read) {
+            entry = &blocks->decoded[e];
+        }
+    }
+    size_t first = block * DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE;
+    size_t count = arr->size - first < DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE ? arr->size - first : DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE;
+    const unsigned char* p = blocks->bytes + blocks->block_offsets[block];
+    size_t shared, header;
+
+    // Rebuild each string from the previous one and its suffix
+    size_t offset = 0, prev_offset = 0;
+    for (size_t k = 0; k < count; k++) {
+        p = ansi_c_dynstringarray_varint_read(p, &shared);
+        p = ansi_c_dynstringarray_varint_read(p, &header);
+        size_t suffix = header >> 1;
+        char* dst = entry->buffer + offset;
+        if (shared > 0) {
+            memcpy(dst, entry->buffer + prev_offset, shared);
+        }
+        if (suffix > 0) {
+            memcpy(dst + shared, p, suffix);
+        }
+        p += suffix;
+        dst[shared + suffix] = '\0';
+        entry->strings[k] = (header & 1) ? NULL : dst;
+        entry->lengths[k] = shared + suffix;
+        prev_offset = offset;
+        offset += shared + suffix + 1;
+    }
+    entry->block = block;
+    entry->last_read = ++blocks->reads;
+    return entry;
+}
+
+static void ansi_c_dynstringarray_free_blocks(struct DynStringArrayBlocks* blocks) {
+    ansi_c_mem_track_free(blocks->cache);
+    ansi_c_mem_track_free(blocks->bytes);
+    ansi_c_mem_track_free(blocks->block_offsets);
+    ansi_c_mem_track_free(blocks);
+}
+
+static DynStringArrayFill* ansi_c_dynstringarray_fill_of(char* value) {
+    return (DynStringArrayFill*)(void*)(value - offsetof(DynStringArrayFill, value));
+}
+
+static char* ansi_c_dynstringarray_fill_create(DynStringArray* arr, const char* value, size_t len) {
+    DynStringArrayFill* fill = (DynStringArrayFill*)DYNSTRINGARRAY_MALLOC(
+        sizeof(DynStringArrayFill) + len + 1, "DynStringArrayFill", arr->data_object_id);
+    if (fill == NULL) {
+        return NULL;
+    }
+    fill->refs = 0;
+    memcpy(fill->value, value, len);
+    fill->value[len] = '\0';
+    return fill->value;
+}
+
+/**
+ * Drops count references to a fill string and frees it when no element shares it any more.
+ */
+static void ansi_c_dynstringarray_fill_release(DynStringArray* arr, char* value, size_t count) {
+    DynStringArrayFill* fill = ansi_c_dynstringarray_fill_of(value);
+    fill->refs -= count;
+    if (fill->refs == 0) {
+        if (arr->fill == value) {
+            arr->fill = NULL;
+            arr->fill_length = 0;
+        }
+        ansi_c_mem_track_free(fill);
+    }
+}
+
+/**
+ * Writes the current fill value into the lazily grown elements below end. Their references to it move along.
+ */
+static void ansi_c_dynstringarray_materialize(DynStringArray* arr, size_t end) {
+    for (size_t i = arr->materialized; i < end; i++) {
+        arr->data[i] = arr->fill;
+        arr->lengths[i] = arr->fill != NULL ? arr->fill_length | DYNSTRINGARRAY_SHARED_LENGTH : 0;
+    }
+    if (end > arr->materialized) {
+        arr->materialized = end;
+    }
+}
+
+/**
+ * Frees the string of a written element, or drops its reference if it shares a fill string.
+ */
+static void ansi_c_dynstringarray_release_slot(DynStringArray* arr, size_t index) {
+    char* value = arr->data[index];
+    if (value == NULL) {
+        return;
+    }
+    if (arr->lengths[index] & DYNSTRINGARRAY_SHARED_LENGTH) {
+        ansi_c_dynstringarray_fill_release(arr, value, 1);
+    }
+    else {
+        ansi_c_mem_track_free(value);
+    }
+}
+
+static const char* ansi_c_dynstringarray_get_n_body(const DynStringArray* arr, size_t index, size_t* len);
+
+/**
+ * Modifying functions work on plain storage only, so a compressed array is decompressed first.
+ * Decompression reuses and then frees the decoded blocks, so if *value was read from the array, it is
+ * redirected to the same characters of the decompressed element. value can be NULL.
+ */
+static bool ansi_c_dynstringarray_ensure_plain(DynStringArray* arr, const char** value) {
+    if (arr->storage_mode == DYN_ARR_PLAIN) {
+        return true;
+    }
+    const struct DynStringArrayBlocks* blocks = arr->blocks;
+    size_t index = DYNSTRINGARRAY_NO_BLOCK, offset = 0;
+    for (size_t e = 0; e < DYNSTRINGARRAY_CACHED_BLOCKS && value != NULL && *value != NULL; e++) {
+        const DynStringArrayDecodedBlock* entry = &blocks->decoded[e];
+        if (entry->block == DYNSTRINGARRAY_NO_BLOCK
+            || *value < entry->buffer || *value >= entry->buffer + blocks->block_capacity) {
+            continue;
+        }
+        size_t first = entry->block * DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE;
+        size_t count = arr->size - first < DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE ? arr->size - first : DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE;
+        for (size_t k = 0; k < count; k++) {
+            const char* str = entry->strings[k];
+            if (str != NULL && *value >= str && *value <= str + entry->lengths[k]) {
+                index = first + k;
+                offset = (size_t)(*value - str);
+                break;
+            }
+        }
+    }
+    if (ansi_c_dynstringarray_decompress(arr) != 0) {
+        return false;
+    }
+    if (index != DYNSTRINGARRAY_NO_BLOCK) {
+        *value = arr->data[index] + offset;
+    }
     return true;
 }
 
@@ -28,7 +327,7 @@ int ansi_c_dynstringarray_create(DynStringArray** arr) {
 
     if (*arr == NULL) {
         size_t sysobjid = ansi_c_mem_track_get_next_object_id();
-        *arr = ansi_c_mem_track_malloc(sizeof(DynStringArray), __FILE__, __FUNCTION__, "DynStringArray", sysobjid);
+        *arr = DYNSTRINGARRAY_MALLOC(sizeof(DynStringArray), "DynStringArray", sysobjid);
         if (*arr == NULL) {
             return -1;
         }
@@ -49,15 +348,22 @@ void ansi_c_dynstringarray_clear(DynStringArray** arr) {
         (*arr)->capacity = DYNSTRINGARRAY_DEFAULT_CAPACITY;
 
         // Allocate new data array and initialize it with NULL
-        char** new_data = (char**)ansi_c_mem_track_malloc(
-            ((*arr)->capacity * sizeof(char*)), __FILE__, __FUNCTION__, "char**", (*arr)->data_object_id);
+        char** new_data = (char**)DYNSTRINGARRAY_MALLOC(
+            ((*arr)->capacity * sizeof(char*)), "char**", (*arr)->data_object_id);
         if (new_data) {
             new_data[0] = NULL;
         }
         (*arr)->data = new_data;
+        (*arr)->lengths = (size_t*)DYNSTRINGARRAY_MALLOC(
+            ((*arr)->capacity * sizeof(size_t)), "size_t*", (*arr)->data_object_id);
 
-        // Reset size and cleanup memory allocations
+        // Reset size, storage mode and fill value and cleanup memory allocations
         (*arr)->size = 0;
+        (*arr)->storage_mode = DYN_ARR_PLAIN;
+        (*arr)->blocks = NULL;
+        (*arr)->materialized = 0;
+        (*arr)->fill = NULL;
+        (*arr)->fill_length = 0;
         ansi_c_mem_track_cleanup_allocations();
     }
 }
@@ -75,76 +381,165 @@ void ansi_c_dynstringarray_destroy(DynStringArray** arr) {
 }
 
 int ansi_c_dynstringarray_resize(DynStringArray* arr, size_t new_size) {
+    return ansi_c_dynstringarray_resize_fill(arr, new_size, NULL);
+}
+
+static int ansi_c_dynstringarray_resize_fill_body(DynStringArray* arr, size_t new_size, const char* value) {
+    if (!ansi_c_dynstringarray_ensure_plain(arr, &value)) {
+        return -1;
+    }
     if (new_size == arr->size) {
         return 0;
     }
     if (new_size < arr->size) {
-        for (size_t i = new_size; i < arr->size; i++) {
-            ansi_c_mem_track_free(arr->data[i]);
+        // Free the written elements, the lazy ones only hold a reference to the fill value
+        for (size_t i = new_size; i < arr->materialized; i++) {
+            ansi_c_dynstringarray_release_slot(arr, i);
+        }
+        size_t lazy = arr->size - (new_size > arr->materialized ? new_size : arr->materialized);
+        if (new_size < arr->materialized) {
+            arr->materialized = new_size;
+        }
+        if (arr->fill != NULL && lazy > 0) {
+            ansi_c_dynstringarray_fill_release(arr, arr->fill, lazy);
         }
     }
     else {
-        size_t new_capacity = arr->capacity;
-        while (new_capacity < new_size) {
-            new_capacity += DYNSTRINGARRAY_DEFAULT_CAPACITY;
+        if (new_size > arr->capacity) {
+            size_t steps = (new_size - arr->capacity + DYNSTRINGARRAY_DEFAULT_CAPACITY - 1) / DYNSTRINGARRAY_DEFAULT_CAPACITY;
+            if (!ansi_c_dynstringarray_realloc_tables(arr, arr->capacity + steps * DYNSTRINGARRAY_DEFAULT_CAPACITY, __FUNCTION__)) {
+                return -1;
+            }
         }
-        char** new_data = ansi_c_mem_track_realloc(arr->data, new_capacity * sizeof(char*), arr->data_object_id);
-        if (new_data == NULL) {
-            return -1;
+
+        // A different fill value replaces the current one for the new elements only. The lazy elements are
+        // written first, so they and the earlier elements keep sharing the string they were grown with.
+        size_t len = value ? strlen(value) : 0;
+        bool same_fill = value == NULL
+            ? arr->fill == NULL
+            : arr->fill != NULL && arr->fill_length == len && memcmp(arr->fill, value, len) == 0;
+        if (!same_fill) {
+            char* fill = NULL;
+            if (value) {
+                fill = ansi_c_dynstringarray_fill_create(arr, value, len);
+                if (fill == NULL) {
+                    return -1;
+                }
+            }
+            ansi_c_dynstringarray_materialize(arr, arr->size);
+            arr->fill = fill;
+            arr->fill_length = len;
         }
-        for (size_t i = arr->size; i < new_size; i++) {
-            new_data[i] = NULL;
+        if (arr->fill != NULL) {
+            ansi_c_dynstringarray_fill_of(arr->fill)->refs += new_size - arr->size;
         }
-        arr->data = new_data;
-        arr->capacity = new_capacity;
     }
     arr->size = new_size;
     return 0;
 }
 
+int ansi_c_dynstringarray_resize_fill(DynStringArray* arr, size_t new_size, const char* value) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_resize_fill_body(arr, new_size, value);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_RESIZE, start, arr->size);
+    return ret;
+}
+
 int ansi_c_dynstringarray_push(DynStringArray* arr, const char* value) {
-    char* new_value = NULL;
-    STRDUP(new_value, strlen(value), value, arr->data_object_id);
+    return ansi_c_dynstringarray_push_n(arr, value, strlen(value));
+}
+
+static int ansi_c_dynstringarray_push_n_body(DynStringArray* arr, const char* value, size_t len) {
+    if (!ansi_c_dynstringarray_ensure_plain(arr, &value)) {
+        return -1;
+    }
+    char* new_value = (char*)DYNSTRINGARRAY_MALLOC(len + 1, "char*", arr->data_object_id);
     if (new_value == NULL) {
         return -1;
     }
+    if (len > 0) {
+        memcpy(new_value, value, len);
+    }
+    new_value[len] = '\0';
 
     if (arr->size == arr->capacity) {
-        if (ansi_c_dynstringarray_resize(arr, arr->size + 1) != 0) {
+        if (!ansi_c_dynstringarray_realloc_tables(arr, arr->capacity + DYNSTRINGARRAY_DEFAULT_CAPACITY, __FUNCTION__)) {
             ansi_c_mem_track_free(new_value);
             return -1;
         }
-    } else {
-        arr->size++;
     }
+    ansi_c_dynstringarray_materialize(arr, arr->size);
 
-    arr->data[arr->size-1] = new_value;
+    arr->data[arr->size] = new_value;
+    arr->lengths[arr->size] = len;
+    arr->size++;
+    arr->materialized = arr->size;
     return 0;
 }
 
-size_t ansi_c_dynstringarray_removeAt(DynStringArray* arr, size_t index, char* buffer, size_t buf_size) {
-    if (index >= arr->size) {
+int ansi_c_dynstringarray_push_n(DynStringArray* arr, const char* value, size_t len) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_push_n_body(arr, value, len);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_PUSH, start, arr->size);
+    return ret;
+}
+
+static int ansi_c_dynstringarray_reserve_body(DynStringArray* arr, size_t capacity) {
+    if (!ansi_c_dynstringarray_ensure_plain(arr, NULL)) {
+        return -1;
+    }
+    if (capacity <= arr->capacity) {
+        return 0;
+    }
+    return ansi_c_dynstringarray_realloc_tables(arr, capacity, __FUNCTION__) ? 0 : -1;
+}
+
+int ansi_c_dynstringarray_reserve(DynStringArray* arr, size_t capacity) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_reserve_body(arr, capacity);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_RESERVE, start, arr->size);
+    return ret;
+}
+
+static size_t ansi_c_dynstringarray_removeAt_body(DynStringArray* arr, size_t index, char* buffer, size_t buf_size) {
+    if (index >= arr->size || !ansi_c_dynstringarray_ensure_plain(arr, NULL)) {
         return arr->size;
     }
 
     if (buffer && buf_size > 0) {
-        size_t len = strlen(arr->data[index]);
+        size_t len = 0;
+        const char* value = ansi_c_dynstringarray_get_n_body(arr, index, &len);
         if (len >= buf_size) {
             len = buf_size - 1;
         }
-        memcpy(buffer, arr->data[index], len);
+        if (len > 0) {
+            memcpy(buffer, value, len);
+        }
         buffer[len] = '\0';
     }
 
-    ansi_c_mem_track_free(arr->data[index]);
-    if (index < arr->size - 1) {
-        memmove(&arr->data[index], &arr->data[index + 1], (arr->size - index - 1) * sizeof(char*));
+    // Only the written elements are moved, the lazy tail shifts with the size
+    if (index < arr->materialized) {
+        ansi_c_dynstringarray_release_slot(arr, index);
+        memmove(&arr->data[index], &arr->data[index + 1], (arr->materialized - index - 1) * sizeof(char*));
+        memmove(&arr->lengths[index], &arr->lengths[index + 1], (arr->materialized - index - 1) * sizeof(size_t));
+        arr->materialized--;
+    }
+    else if (arr->fill != NULL) {
+        ansi_c_dynstringarray_fill_release(arr, arr->fill, 1);
     }
     arr->size--;
 
     return arr->size;
 }
 
+size_t ansi_c_dynstringarray_removeAt(DynStringArray* arr, size_t index, char* buffer, size_t buf_size) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    size_t ret = ansi_c_dynstringarray_removeAt_body(arr, index, buffer, buf_size);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_REMOVE_AT, start, arr->size);
+    return ret;
+}
+
 size_t ansi_c_dynstringarray_size(DynStringArray* arr) {
     return arr->size;
 }
@@ -164,59 +559,303 @@ void ansi_c_dynstringarray_init(DynStringArray* arr, size_t count, ...) {
 }
 
 const char* ansi_c_dynstringarray_get(const DynStringArray* arr, size_t index) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    const char* ret = ansi_c_dynstringarray_get_n_body(arr, index, NULL);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_GET, start, arr->size);
+    return ret;
+}
+
+static const char* ansi_c_dynstringarray_get_n_body(const DynStringArray* arr, size_t index, size_t* len) {
     if (index >= arr->size) {
+        if (len) {
+            *len = 0;
+        }
         return NULL;
     }
+    if (arr->storage_mode == DYN_ARR_COMPRESSED) {
+        size_t k = index % DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE;
+        const DynStringArrayDecodedBlock* entry = ansi_c_dynstringarray_decode_block(arr, index / DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE);
+        if (len) {
+            *len = entry->lengths[k];
+        }
+        return entry->strings[k];
+    }
+    if (index >= arr->materialized) {
+        if (len) {
+            *len = arr->fill_length;
+        }
+        return arr->fill;
+    }
+    if (len) {
+        *len = arr->lengths[index] & ~DYNSTRINGARRAY_SHARED_LENGTH;
+    }
     return arr->data[index];
 }
 
-int ansi_c_dynstringarray_set(DynStringArray* arr, size_t index, const char* value)
+const char* ansi_c_dynstringarray_get_n(const DynStringArray* arr, size_t index, size_t* len) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    const char* ret = ansi_c_dynstringarray_get_n_body(arr, index, len);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_GET, start, arr->size);
+    return ret;
+}
+
+static int ansi_c_dynstringarray_get_copy_body(const DynStringArray* arr, size_t index, char* buffer, size_t buf_size) {
+    size_t len = 0;
+    const char* value = ansi_c_dynstringarray_get_n_body(arr, index, &len);
+    if (value == NULL || buffer == NULL || buf_size == 0) {
+        return -1;
+    }
+    if (len >= buf_size) {
+        len = buf_size - 1;
+    }
+    memcpy(buffer, value, len);
+    buffer[len] = '\0';
+    return 0;
+}
+
+int ansi_c_dynstringarray_get_copy(const DynStringArray* arr, size_t index, char* buffer, size_t buf_size) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_get_copy_body(arr, index, buffer, buf_size);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_GET, start, arr->size);
+    return ret;
+}
+
+static int ansi_c_dynstringarray_set_body(DynStringArray* arr, size_t index, const char* value)
 {
-    if (index >= arr->size) {
+    if (index >= arr->size || !ansi_c_dynstringarray_ensure_plain(arr, &value)) {
         return -1;
     }
 
     size_t new_str_len = strlen(value), new_buff_size= new_str_len + 1;
+    ansi_c_dynstringarray_materialize(arr, index + 1);
     char** poi = &arr->data[index];
-    if (strlen(arr->data[index]) < strlen(value)) {
-        *poi = ansi_c_mem_track_realloc(*poi, new_buff_size, arr->data_object_id);
-        if (*poi == NULL) {
+    if (*poi == NULL || (arr->lengths[index] & DYNSTRINGARRAY_SHARED_LENGTH)) {
+        // NULL and shared fill elements get their own copy. value may be the fill string, so it is copied
+        // before the reference is dropped.
+        char* new_value = (char*)DYNSTRINGARRAY_MALLOC(new_buff_size, "char*", arr->data_object_id);
+        if (new_value == NULL) {
             return -1;
         }
+        memcpy(new_value, value, new_buff_size);
+        if (*poi != NULL) {
+            ansi_c_dynstringarray_fill_release(arr, *poi, 1);
+        }
+        *poi = new_value;
     }
-    STRCPY(*poi, new_buff_size, value);
+    else {
+        if (arr->lengths[index] < new_str_len) {
+            char* old_value = *poi;
+            *poi = ansi_c_mem_track_realloc(old_value, new_buff_size, arr->data_object_id);
+            DYNSTRINGARRAY_PROFILE_REALLOC(__FUNCTION__, "char*", old_value, *poi, arr->lengths[index] + 1, new_buff_size);
+            if (*poi == NULL) {
+                return -1;
+            }
+        }
+        // value may be the element itself or a part of it
+        memmove(*poi, value, new_buff_size);
+    }
+    arr->lengths[index] = new_str_len;
     return 0;
 }
 
-int ansi_c_dynstringarray_insert(DynStringArray* arr, size_t index, const char* value)
+int ansi_c_dynstringarray_set(DynStringArray* arr, size_t index, const char* value)
+{
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_set_body(arr, index, value);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_SET, start, arr->size);
+    return ret;
+}
+
+static int ansi_c_dynstringarray_insert_body(DynStringArray* arr, size_t index, const char* value)
 {
     // If the index is out of range, return an error
-    if (index > arr->size) {
+    if (index > arr->size || !ansi_c_dynstringarray_ensure_plain(arr, &value)) {
         return -1;
     }
 
     // If inserting at the end of the array, simply push the string
     if (index == arr->size) {
-        return ansi_c_dynstringarray_push(arr, value);
+        return ansi_c_dynstringarray_push_n_body(arr, value, strlen(value));
     }
 
     // If the array is full, resize it
     if (arr->size == arr->capacity) {
         size_t new_capacity = arr->capacity + DYNSTRINGARRAY_DEFAULT_CAPACITY;
-        char** new_data = ansi_c_mem_track_realloc(arr->data, new_capacity * sizeof(char*), arr->data_object_id);
-        if (new_data == NULL) {
+        if (!ansi_c_dynstringarray_realloc_tables(arr, new_capacity, __FUNCTION__)) {
             return -1;
         }
-        arr->data = new_data;
-        arr->capacity = new_capacity;
     }
 
+    // Copy the new string before anything is moved
+    size_t len = strlen(value);
+    char* new_value = (char*)DYNSTRINGARRAY_MALLOC(len + 1, "char*", arr->data_object_id);
+    if (new_value == NULL) {
+        return -1;
+    }
+    memcpy(new_value, value, len + 1);
+
     // Move the existing strings to make room for the new string
+    ansi_c_dynstringarray_materialize(arr, arr->size);
     memmove(&arr->data[index + 1], &arr->data[index], (arr->size - index) * sizeof(char*));
+    memmove(&arr->lengths[index + 1], &arr->lengths[index], (arr->size - index) * sizeof(size_t));
 
     // Insert the new string into the array
-    STRDUP(arr->data[index], strlen(value), value, arr->data_object_id);
+    arr->data[index] = new_value;
+    arr->lengths[index] = len;
     arr->size++;
+    arr->materialized = arr->size;
 
     return 0;
 }
+
+int ansi_c_dynstringarray_insert(DynStringArray* arr, size_t index, const char* value)
+{
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_insert_body(arr, index, value);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_INSERT, start, arr->size);
+    return ret;
+}
+
+static int ansi_c_dynstringarray_compress_body(DynStringArray* arr) {
+    if (arr->storage_mode == DYN_ARR_COMPRESSED) {
+        return 0;
+    }
+
+    // Measure the encoded size and the largest decoded block first, so that the blocks and the decode cache
+    // are allocated only once
+    ansi_c_dynstringarray_materialize(arr, arr->size);
+    size_t block_count = (arr->size + DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE - 1) / DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE;
+    size_t total = 0, block_capacity = 1, decoded_size = 0;
+    for (size_t i = 0; i < arr->size; i++) {
+        total += ansi_c_dynstringarray_encode_entry(arr, i, NULL);
+        if (i % DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE == 0) {
+            decoded_size = 0;
+        }
+        decoded_size += (arr->lengths[i] & ~DYNSTRINGARRAY_SHARED_LENGTH) + 1;
+        if (decoded_size > block_capacity) {
+            block_capacity = decoded_size;
+        }
+    }
+
+    struct DynStringArrayBlocks* blocks = DYNSTRINGARRAY_MALLOC(
+        sizeof(struct DynStringArrayBlocks), "DynStringArrayBlocks", arr->data_object_id);
+    size_t* block_offsets = DYNSTRINGARRAY_MALLOC(
+        (block_count + 1) * sizeof(size_t), "size_t*", arr->data_object_id);
+    unsigned char* bytes = DYNSTRINGARRAY_MALLOC(
+        total > 0 ? total : 1, "unsigned char*", arr->data_object_id);
+    char* cache = DYNSTRINGARRAY_MALLOC(
+        DYNSTRINGARRAY_CACHED_BLOCKS * block_capacity, "char*", arr->data_object_id);
+    if (!blocks || !block_offsets || !bytes || !cache) {
+        if (blocks) {
+            ansi_c_mem_track_free(blocks);
+        }
+        if (block_offsets) {
+            ansi_c_mem_track_free(block_offsets);
+        }
+        if (bytes) {
+            ansi_c_mem_track_free(bytes);
+        }
+        if (cache) {
+            ansi_c_mem_track_free(cache);
+        }
+        return -1;
+    }
+
+    // Encode the blocks
+    size_t offset = 0;
+    for (size_t i = 0; i < arr->size; i++) {
+        if (i % DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE == 0) {
+            block_offsets[i / DYNSTRINGARRAY_COMPRESSED_BLOCK_SIZE] = offset;
+        }
+        offset += ansi_c_dynstringarray_encode_entry(arr, i, bytes + offset);
+    }
+    block_offsets[block_count] = offset;
+    blocks->block_count = block_count;
+    blocks->block_offsets = block_offsets;
+    blocks->bytes = bytes;
+    blocks->cache = cache;
+    blocks->block_capacity = block_capacity;
+    blocks->reads = 0;
+    for (size_t e = 0; e < DYNSTRINGARRAY_CACHED_BLOCKS; e++) {
+        blocks->decoded[e].block = DYNSTRINGARRAY_NO_BLOCK;
+        blocks->decoded[e].last_read = 0;
+        blocks->decoded[e].buffer = cache + e * block_capacity;
+    }
+
+    // Release the plain storage
+    for (size_t i = 0; i < arr->size; i++) {
+        ansi_c_dynstringarray_release_slot(arr, i);
+    }
+    ansi_c_mem_track_free(arr->data);
+    ansi_c_mem_track_free(arr->lengths);
+    arr->data = NULL;
+    arr->lengths = NULL;
+    arr->capacity = 0;
+    arr->blocks = blocks;
+    arr->storage_mode = DYN_ARR_COMPRESSED;
+    return 0;
+}
+
+int ansi_c_dynstringarray_compress(DynStringArray* arr) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_compress_body(arr);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_COMPRESS, start, arr->size);
+    return ret;
+}
+
+static int ansi_c_dynstringarray_decompress_body(DynStringArray* arr) {
+    if (arr->storage_mode == DYN_ARR_PLAIN) {
+        return 0;
+    }
+
+    size_t capacity = arr->size > DYNSTRINGARRAY_DEFAULT_CAPACITY ? arr->size : DYNSTRINGARRAY_DEFAULT_CAPACITY;
+    char** data = (char**)DYNSTRINGARRAY_MALLOC(capacity * sizeof(char*), "char**", arr->data_object_id);
+    size_t* lengths = (size_t*)DYNSTRINGARRAY_MALLOC(capacity * sizeof(size_t), "size_t*", arr->data_object_id);
+    size_t i = 0;
+    if (data && lengths) {
+        for (; i < arr->size; i++) {
+            size_t len = 0;
+            const char* value = ansi_c_dynstringarray_get_n_body(arr, i, &len);
+            data[i] = NULL;
+            lengths[i] = len;
+            if (value) {
+                data[i] = (char*)DYNSTRINGARRAY_MALLOC(len + 1, "char*", arr->data_object_id);
+                if (data[i] == NULL) {
+                    break;
+                }
+                memcpy(data[i], value, len + 1);
+            }
+        }
+    }
+    if (i < arr->size || !data || !lengths) {
+        // Roll back, the array stays compressed
+        for (size_t j = 0; data && j < i; j++) {
+            if (data[j]) {
+                ansi_c_mem_track_free(data[j]);
+            }
+        }
+        if (data) {
+            ansi_c_mem_track_free(data);
+        }
+        if (lengths) {
+            ansi_c_mem_track_free(lengths);
+        }
+        return -1;
+    }
+
+    ansi_c_dynstringarray_free_blocks(arr->blocks);
+    arr->blocks = NULL;
+    arr->data = data;
+    arr->lengths = lengths;
+    arr->capacity = capacity;
+    arr->materialized = arr->size;
+    arr->storage_mode = DYN_ARR_PLAIN;
+    return 0;
+}
+
+int ansi_c_dynstringarray_decompress(DynStringArray* arr) {
+    DYNSTRINGARRAY_PROFILE_BEGIN(start);
+    int ret = ansi_c_dynstringarray_decompress_body(arr);
+    DYNSTRINGARRAY_PROFILE_END(DYN_ARR_OP_DECOMPRESS, start, arr->size);
+    return ret;
+}
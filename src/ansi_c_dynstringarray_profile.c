@@ -0,0 +1,392 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "../include/ansi_c_dynstringarray_profile.h"
+#include "../include/ansi_c_mem_track.h"
+
+// Linear sub-buckets per power of two of the latency histogram (2^4), and the buckets needed up to UINT64_MAX
+#define DYNSTRINGARRAY_PROFILE_SUB_BUCKETS 16
+#define DYNSTRINGARRAY_PROFILE_LATENCY_BUCKETS ((64 - 3) * DYNSTRINGARRAY_PROFILE_SUB_BUCKETS)
+
+typedef enum {
+    DYN_ARR_EVENT_OP,
+    DYN_ARR_EVENT_REALLOC
+} dyn_arr_profile_event_kind;
+
+typedef struct {
+    dyn_arr_profile_event_kind kind;
+    dyn_arr_profile_op op; /*< Operation of DYN_ARR_EVENT_OP events*/
+    const char* call_site; /*< Call site of DYN_ARR_EVENT_REALLOC events*/
+    const char* type; /*< Type of the block reallocated by DYN_ARR_EVENT_REALLOC events*/
+    uint64_t ts_ns; /*< Start time relative to ansi_c_dynstringarray_profile_start*/
+    uint64_t dur_ns; /*< Duration of DYN_ARR_EVENT_OP events*/
+    size_t size; /*< Array size after the operation, or the old size of the reallocated block*/
+    size_t new_size; /*< New size of the reallocated block*/
+    size_t bytes_moved; /*< Bytes copied by the reallocation*/
+} DynStringArrayProfileEvent;
+
+typedef struct {
+    size_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    size_t histogram[DYNSTRINGARRAY_PROFILE_LATENCY_BUCKETS];
+} DynStringArrayOpHistogram;
+
+static const char* const op_names[DYN_ARR_OP_COUNT] = {
+    "push", "insert", "set", "get", "removeAt", "resize", "reserve", "compress", "decompress"
+};
+
+static bool profile_enabled = false;
+static uint64_t profile_origin_ns = 0;
+static DynStringArrayOpHistogram op_histograms[DYN_ARR_OP_COUNT];
+static DynStringArrayAllocStats alloc_stats[DYNSTRINGARRAY_PROFILE_MAX_CALL_SITES];
+static size_t alloc_stats_count = 0;
+static DynStringArrayProfileEvent events[DYNSTRINGARRAY_PROFILE_MAX_EVENTS];
+static size_t events_count = 0;
+static size_t events_dropped = 0;
+static DynStringArrayProfileEvent sampled_events[DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS];
+static size_t sampled_total = 0; /*< Number of events sampled into the ring buffer*/
+static size_t other_events = 0; /*< Number of events that are not always kept*/
+
+static unsigned int ansi_c_dynstringarray_profile_bucket(uint64_t value) {
+    unsigned int bucket = 0;
+    while (value > 1 && bucket < 63) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * Returns the latency bucket of a value. Values below DYNSTRINGARRAY_PROFILE_SUB_BUCKETS have a bucket each;
+ * every larger power of two is split into DYNSTRINGARRAY_PROFILE_SUB_BUCKETS linear sub-buckets, so a bucket
+ * is never wider than 1/16 of its values.
+ */
+static unsigned int ansi_c_dynstringarray_profile_latency_bucket(uint64_t value) {
+    if (value < DYNSTRINGARRAY_PROFILE_SUB_BUCKETS) {
+        return (unsigned int)value;
+    }
+    unsigned int msb = ansi_c_dynstringarray_profile_bucket(value);
+    unsigned int sub = (unsigned int)(value >> (msb - 4)) & (DYNSTRINGARRAY_PROFILE_SUB_BUCKETS - 1);
+    return (msb - 3) * DYNSTRINGARRAY_PROFILE_SUB_BUCKETS + sub;
+}
+
+/**
+ * Returns the largest value of a latency bucket.
+ */
+static uint64_t ansi_c_dynstringarray_profile_latency_upper(unsigned int bucket) {
+    if (bucket < DYNSTRINGARRAY_PROFILE_SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned int shift = bucket / DYNSTRINGARRAY_PROFILE_SUB_BUCKETS - 1;
+    uint64_t lower = (uint64_t)(DYNSTRINGARRAY_PROFILE_SUB_BUCKETS + bucket % DYNSTRINGARRAY_PROFILE_SUB_BUCKETS) << shift;
+    return lower + (((uint64_t)1 << shift) - 1);
+}
+
+/**
+ * Returns the smallest value of a log2 size bucket.
+ */
+static size_t ansi_c_dynstringarray_profile_bucket_floor(unsigned int bucket) {
+    return bucket == 0 ? 0 : (size_t)1 << bucket;
+}
+
+static uint64_t ansi_c_dynstringarray_profile_percentile(const DynStringArrayOpHistogram* h, unsigned int percent) {
+    if (h->count == 0) {
+        return 0;
+    }
+    size_t rank = (h->count * percent + 99) / 100, seen = 0;
+    for (unsigned int b = 0; b < DYNSTRINGARRAY_PROFILE_LATENCY_BUCKETS; b++) {
+        seen += h->histogram[b];
+        if (seen >= rank) {
+            uint64_t upper = ansi_c_dynstringarray_profile_latency_upper(b);
+            return upper < h->max_ns ? upper : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+/**
+ * Returns the slot of a new trace event, or NULL if the event is not recorded. Events to keep get a slot of
+ * their own while there is room; the others are sampled into a ring buffer that overwrites the oldest ones.
+ */
+static DynStringArrayProfileEvent* ansi_c_dynstringarray_profile_new_event(bool keep) {
+    if (keep) {
+        if (events_count == DYNSTRINGARRAY_PROFILE_MAX_EVENTS) {
+            events_dropped++;
+            return NULL;
+        }
+        return &events[events_count++];
+    }
+    if (other_events++ % DYNSTRINGARRAY_PROFILE_SAMPLE_RATE != 0) {
+        return NULL;
+    }
+    return &sampled_events[sampled_total++ % DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS];
+}
+
+static bool ansi_c_dynstringarray_profile_same_name(const char* a, const char* b) {
+    return a == b || strcmp(a, b) == 0;
+}
+
+/**
+ * Returns the statistics of a call site, keyed on the allocating function and the type of the block, so that
+ * the string buffers and the tables allocated by one function are counted apart.
+ */
+static DynStringArrayAllocStats* ansi_c_dynstringarray_profile_site(const char* call_site, const char* type) {
+    for (size_t i = 0; i < alloc_stats_count; i++) {
+        if (ansi_c_dynstringarray_profile_same_name(alloc_stats[i].call_site, call_site)
+            && ansi_c_dynstringarray_profile_same_name(alloc_stats[i].type, type)) {
+            return &alloc_stats[i];
+        }
+    }
+    if (alloc_stats_count == DYNSTRINGARRAY_PROFILE_MAX_CALL_SITES) {
+        return NULL;
+    }
+    DynStringArrayAllocStats* site = &alloc_stats[alloc_stats_count++];
+    memset(site, 0, sizeof(*site));
+    site->call_site = call_site;
+    site->type = type;
+    return site;
+}
+
+uint64_t ansi_c_dynstringarray_profile_now(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void ansi_c_dynstringarray_profile_start(void) {
+    memset(op_histograms, 0, sizeof(op_histograms));
+    alloc_stats_count = 0;
+    events_count = 0;
+    events_dropped = 0;
+    sampled_total = 0;
+    other_events = 0;
+    profile_origin_ns = ansi_c_dynstringarray_profile_now();
+    profile_enabled = true;
+}
+
+void ansi_c_dynstringarray_profile_stop(void) {
+    profile_enabled = false;
+}
+
+void ansi_c_dynstringarray_profile_record_op(dyn_arr_profile_op op, uint64_t start_ns, size_t size) {
+    if (!profile_enabled || op >= DYN_ARR_OP_COUNT) {
+        return;
+    }
+    uint64_t duration = ansi_c_dynstringarray_profile_now() - start_ns;
+    DynStringArrayOpHistogram* h = &op_histograms[op];
+    h->count++;
+    h->total_ns += duration;
+    if (duration > h->max_ns) {
+        h->max_ns = duration;
+    }
+    h->histogram[ansi_c_dynstringarray_profile_latency_bucket(duration)]++;
+
+    DynStringArrayProfileEvent* event = ansi_c_dynstringarray_profile_new_event(duration >= DYNSTRINGARRAY_PROFILE_SLOW_OP_NS);
+    if (event) {
+        event->kind = DYN_ARR_EVENT_OP;
+        event->op = op;
+        event->call_site = NULL;
+        event->type = NULL;
+        event->ts_ns = start_ns - profile_origin_ns;
+        event->dur_ns = duration;
+        event->size = size;
+        event->new_size = 0;
+        event->bytes_moved = 0;
+    }
+}
+
+void ansi_c_dynstringarray_profile_record_alloc(const char* call_site, const char* type, const void* old_ptr, const void* new_ptr, size_t old_size, size_t new_size) {
+    if (!profile_enabled || new_ptr == NULL) {
+        return;
+    }
+    DynStringArrayAllocStats* site = ansi_c_dynstringarray_profile_site(call_site, type);
+    if (site) {
+        site->count++;
+        site->total_bytes += new_size;
+        if (new_size > site->max_bytes) {
+            site->max_bytes = new_size;
+        }
+        site->size_histogram[ansi_c_dynstringarray_profile_bucket(new_size)]++;
+    }
+    if (old_ptr == NULL) {
+        return;
+    }
+
+    // A reallocation that returns a new block copies the smaller of the two sizes
+    size_t moved = new_ptr != old_ptr ? (old_size < new_size ? old_size : new_size) : 0;
+    if (site) {
+        site->realloc_count++;
+        site->bytes_moved += moved;
+    }
+    DynStringArrayProfileEvent* event = ansi_c_dynstringarray_profile_new_event(moved > 0);
+    if (event) {
+        event->kind = DYN_ARR_EVENT_REALLOC;
+        event->op = DYN_ARR_OP_COUNT;
+        event->call_site = call_site;
+        event->type = type;
+        event->ts_ns = ansi_c_dynstringarray_profile_now() - profile_origin_ns;
+        event->dur_ns = 0;
+        event->size = old_size;
+        event->new_size = new_size;
+        event->bytes_moved = moved;
+    }
+}
+
+void* ansi_c_dynstringarray_profile_malloc(size_t size, const char* file, const char* function, const char* type, size_t object_id) {
+    void* ptr = ansi_c_mem_track_malloc(size, file, function, type, object_id);
+    ansi_c_dynstringarray_profile_record_alloc(function, type, NULL, ptr, 0, size);
+    return ptr;
+}
+
+bool ansi_c_dynstringarray_profile_get_op_stats(dyn_arr_profile_op op, DynStringArrayOpStats* stats) {
+    if (op >= DYN_ARR_OP_COUNT || stats == NULL) {
+        return false;
+    }
+    const DynStringArrayOpHistogram* h = &op_histograms[op];
+    stats->count = h->count;
+    stats->total_ns = h->total_ns;
+    stats->p50_ns = ansi_c_dynstringarray_profile_percentile(h, 50);
+    stats->p99_ns = ansi_c_dynstringarray_profile_percentile(h, 99);
+    stats->max_ns = h->max_ns;
+    return true;
+}
+
+const DynStringArrayAllocStats* ansi_c_dynstringarray_profile_get_alloc_stats(size_t* count) {
+    if (count) {
+        *count = alloc_stats_count;
+    }
+    return alloc_stats;
+}
+
+static FILE* ansi_c_dynstringarray_profile_open(const char* filename) {
+#if defined(_MSC_VER)
+    FILE* file = NULL;
+    return fopen_s(&file, filename, "w") == 0 ? file : NULL;
+#else
+    return fopen(filename, "w");
+#endif
+}
+
+static void ansi_c_dynstringarray_profile_write_event(FILE* file, const DynStringArrayProfileEvent* e, const char* separator) {
+    // Timestamps are in microseconds
+    if (e->kind == DYN_ARR_EVENT_OP) {
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"op\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+            "\"args\":{\"size\":%zu}}%s\n",
+            op_names[e->op], (double)e->ts_ns / 1000.0, (double)e->dur_ns / 1000.0, e->size, separator);
+    }
+    else {
+        fprintf(file, "{\"name\":\"realloc\",\"cat\":\"alloc\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+            "\"args\":{\"site\":\"%s\",\"type\":\"%s\",\"old_size\":%zu,\"new_size\":%zu,\"bytes_moved\":%zu}}%s\n",
+            (double)e->ts_ns / 1000.0, e->call_site, e->type, e->size, e->new_size, e->bytes_moved, separator);
+    }
+}
+
+int ansi_c_dynstringarray_profile_write_trace(const char* filename) {
+    FILE* file = ansi_c_dynstringarray_profile_open(filename);
+    if (file == NULL) {
+        return -1;
+    }
+
+    // The kept events, then the sampled ones still in the ring buffer from the oldest
+    size_t sampled_count = sampled_total < DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS ? sampled_total : DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS;
+    size_t sampled_first = sampled_total - sampled_count, total = events_count + sampled_count;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < total; i++) {
+        const DynStringArrayProfileEvent* e = i < events_count
+            ? &events[i]
+            : &sampled_events[(sampled_first + i - events_count) % DYNSTRINGARRAY_PROFILE_MAX_SAMPLED_EVENTS];
+        ansi_c_dynstringarray_profile_write_event(file, e, i + 1 < total ? "," : "");
+    }
+
+    // Statistics
+    fprintf(file, "],\n\"dynStringArrayProfile\":{\"droppedEvents\":%zu,\"unsampledEvents\":%zu,\"ops\":{",
+        events_dropped, other_events - sampled_count);
+    bool first = true;
+    for (int op = 0; op < DYN_ARR_OP_COUNT; op++) {
+        DynStringArrayOpStats stats;
+        ansi_c_dynstringarray_profile_get_op_stats((dyn_arr_profile_op)op, &stats);
+        if (stats.count == 0) {
+            continue;
+        }
+        fprintf(file, "%s\n\"%s\":{\"count\":%zu,\"p50_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu}",
+            first ? "" : ",", op_names[op], stats.count, (unsigned long long)stats.p50_ns,
+            (unsigned long long)stats.p99_ns, (unsigned long long)stats.max_ns);
+        first = false;
+    }
+    fprintf(file, "},\"allocs\":{");
+    for (size_t i = 0; i < alloc_stats_count; i++) {
+        const DynStringArrayAllocStats* site = &alloc_stats[i];
+        fprintf(file, "%s\n\"%s:%s\":{\"count\":%zu,\"total_bytes\":%zu,\"max_bytes\":%zu,\"realloc_count\":%zu,\"bytes_moved\":%zu,"
+            "\"size_histogram\":{",
+            i == 0 ? "" : ",", site->call_site, site->type, site->count, site->total_bytes, site->max_bytes,
+            site->realloc_count, site->bytes_moved);
+
+        // Non-empty log2 buckets keyed by their smallest size
+        bool first_bucket = true;
+        for (unsigned int b = 0; b < 64; b++) {
+            if (site->size_histogram[b] > 0) {
+                fprintf(file, "%s\"%zu\":%zu", first_bucket ? "" : ",", ansi_c_dynstringarray_profile_bucket_floor(b),
+                    site->size_histogram[b]);
+                first_bucket = false;
+            }
+        }
+        fprintf(file, "}}");
+    }
+    fprintf(file, "}}}\n");
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0) {
+        failed = true;
+    }
+    return failed ? -1 : 0;
+}
+
+void ansi_c_dynstringarray_profile_log_summary(void) {
+    char line[1024];
+    for (int op = 0; op < DYN_ARR_OP_COUNT; op++) {
+        DynStringArrayOpStats stats;
+        ansi_c_dynstringarray_profile_get_op_stats((dyn_arr_profile_op)op, &stats);
+        if (stats.count == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%s: count=%zu p50=%lluns p99=%lluns max=%lluns", op_names[op], stats.count,
+            (unsigned long long)stats.p50_ns, (unsigned long long)stats.p99_ns, (unsigned long long)stats.max_ns);
+        ansi_c_mem_track_log_message(NULL, "Profile", line);
+    }
+    for (size_t i = 0; i < alloc_stats_count; i++) {
+        const DynStringArrayAllocStats* site = &alloc_stats[i];
+        int used = snprintf(line, sizeof(line), "alloc %s (%s): count=%zu total=%zu max=%zu reallocs=%zu moved=%zu sizes=",
+            site->call_site, site->type, site->count, site->total_bytes, site->max_bytes, site->realloc_count, site->bytes_moved);
+
+        // Non-empty log2 buckets as [floor]=count
+        for (unsigned int b = 0; b < 64 && used > 0 && (size_t)used < sizeof(line); b++) {
+            if (site->size_histogram[b] > 0) {
+                used += snprintf(line + used, sizeof(line) - (size_t)used, "[%zu]=%zu ",
+                    ansi_c_dynstringarray_profile_bucket_floor(b), site->size_histogram[b]);
+            }
+        }
+        ansi_c_mem_track_log_message(NULL, "Profile", line);
+    }
+    if (events_dropped > 0) {
+        snprintf(line, sizeof(line), "dropped trace events=%zu", events_dropped);
+        ansi_c_mem_track_log_message(NULL, "Profile", line);
+    }
+}